@@ -0,0 +1,251 @@
+#include "Benchmark.h"
+#include "PowermateManager.h"
+#include "OutputPacer.h"
+#include "LowLatency.h"
+#include <winternl.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Context switch counters of the process and two of its threads
+struct SwitchCounts {
+    ULONG reader = 0;
+    ULONG pacer = 0;
+    ULONG64 process = 0;
+};
+
+// Snapshot of the idle counters
+struct IdleSample {
+    ULONG64 readerCycles = 0;
+    ULONG64 pacerCycles = 0;
+    ULONG64 cpuTime = 0;    // 100ns units
+    LONGLONG counter = 0;   // QueryPerformanceCounter
+    SwitchCounts switches;
+};
+
+using NtQuerySystemInformationFn = NTSTATUS (NTAPI*)(SYSTEM_INFORMATION_CLASS, PVOID, ULONG, PULONG);
+
+// Read per-thread context switch counts, each one is a wakeup
+bool QuerySwitchCounts(DWORD readerId, DWORD pacerId, SwitchCounts& out) {
+    static auto query = reinterpret_cast<NtQuerySystemInformationFn>(
+        GetProcAddress(GetModuleHandleW(L"ntdll.dll"), "NtQuerySystemInformation"));
+    if (!query) return false;
+
+    std::vector<BYTE> buffer(256 * 1024);
+    NTSTATUS status;
+    ULONG needed = 0;
+    while ((status = query(SystemProcessInformation, buffer.data(), static_cast<ULONG>(buffer.size()), &needed))
+           == static_cast<NTSTATUS>(0xC0000004L)) { // STATUS_INFO_LENGTH_MISMATCH
+        buffer.resize(needed + 64 * 1024);
+    }
+    if (status < 0) return false;
+
+    DWORD pid = GetCurrentProcessId();
+    auto* process = reinterpret_cast<SYSTEM_PROCESS_INFORMATION*>(buffer.data());
+    for (;;) {
+        if (HandleToULong(process->UniqueProcessId) == pid) {
+            // Thread entries directly follow the process entry
+            auto* threads = reinterpret_cast<SYSTEM_THREAD_INFORMATION*>(process + 1);
+            out = SwitchCounts();
+            for (ULONG i = 0; i < process->NumberOfThreads; ++i) {
+                ULONG switches = threads[i].Reserved3; // ContextSwitches
+                DWORD tid = HandleToULong(threads[i].ClientId.UniqueThread);
+                out.process += switches;
+                if (tid == readerId) out.reader = switches;
+                if (tid == pacerId) out.pacer = switches;
+            }
+            return true;
+        }
+        if (process->NextEntryOffset == 0) return false;
+        process = reinterpret_cast<SYSTEM_PROCESS_INFORMATION*>(reinterpret_cast<BYTE*>(process) + process->NextEntryOffset);
+    }
+}
+
+ULONG64 ThreadCycles(HANDLE thread) {
+    ULONG64 cycles = 0;
+    if (thread) QueryThreadCycleTime(thread, &cycles);
+    return cycles;
+}
+
+ULONG64 ProcessCpuTime() {
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) return 0;
+    auto toUInt = [](const FILETIME& ft) { return (static_cast<ULONG64>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime; };
+    return toUInt(kernel) + toUInt(user);
+}
+
+IdleSample TakeSample(HANDLE reader, HANDLE pacer) {
+    IdleSample sample;
+    sample.readerCycles = ThreadCycles(reader);
+    sample.pacerCycles = ThreadCycles(pacer);
+    sample.cpuTime = ProcessCpuTime();
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    sample.counter = now.QuadPart;
+    QuerySwitchCounts(reader ? GetThreadId(reader) : 0, pacer ? GetThreadId(pacer) : 0, sample.switches);
+    return sample;
+}
+
+// Signal a waiting thread once per millisecond, returning signal-to-wakeup times in microseconds
+std::vector<double> MeasureWakeups(size_t samples) {
+    std::vector<double> latencies(samples);
+    std::atomic<LONGLONG> signalTime(0);
+    HANDLE wake = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    HANDLE ack = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    HANDLE timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (!timer) timer = CreateWaitableTimerW(nullptr, FALSE, nullptr);
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+
+    // Same setup as the input thread: priority comes from LowLatency
+    std::thread waiter([&]() {
+        HANDLE mmcssTask = LowLatency::ApplyToCurrentThread();
+        for (size_t i = 0; i < samples; ++i) {
+            WaitForSingleObject(wake, INFINITE);
+            LARGE_INTEGER now;
+            QueryPerformanceCounter(&now);
+            latencies[i] = (now.QuadPart - signalTime.load(std::memory_order_acquire)) * 1e6 / frequency.QuadPart;
+            SetEvent(ack);
+        }
+        LowLatency::RevertCurrentThread(mmcssTask);
+    });
+
+    // Keep the signaller itself ahead of the background load
+    int previousPriority = GetThreadPriority(GetCurrentThread());
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+
+    LARGE_INTEGER dueTime;
+    dueTime.QuadPart = -10000; // 1 ms, relative
+    for (size_t i = 0; i < samples; ++i) {
+        SetWaitableTimer(timer, &dueTime, 0, nullptr, nullptr, FALSE);
+        WaitForSingleObject(timer, INFINITE);
+
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        signalTime.store(now.QuadPart, std::memory_order_release);
+        SetEvent(wake);
+        WaitForSingleObject(ack, INFINITE);
+    }
+
+    SetThreadPriority(GetCurrentThread(), previousPriority);
+    waiter.join();
+    CloseHandle(timer);
+    CloseHandle(ack);
+    CloseHandle(wake);
+    return latencies;
+}
+
+void PrintPercentiles(const wchar_t* label, std::vector<double> latencies) {
+    std::sort(latencies.begin(), latencies.end());
+    auto at = [&](double p) { return latencies[static_cast<size_t>(p * (latencies.size() - 1))]; };
+    wprintf(L"[Bench] %-12ls p50 %8.1f us  p90 %8.1f us  p99 %8.1f us  p99.9 %8.1f us  max %8.1f us\n",
+            label, at(0.50), at(0.90), at(0.99), at(0.999), latencies.back());
+}
+
+}  // namespace
+
+// Dispatch window messages until the delay expires
+bool Benchmark::PumpMessagesFor(DWORD milliseconds) {
+    ULONGLONG deadline = GetTickCount64() + milliseconds;
+    for (;;) {
+        ULONGLONG now = GetTickCount64();
+        if (now >= deadline) return true;
+
+        MsgWaitForMultipleObjects(0, nullptr, FALSE, static_cast<DWORD>(deadline - now), QS_ALLINPUT);
+
+        MSG msg;
+        while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
+            if (msg.message == WM_QUIT) return false;
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+    }
+}
+
+// Measure wakeups and CPU time of the idle application
+int Benchmark::RunIdle(const wchar_t* expectedState) {
+    const DWORD durationMs = 60 * 1000;
+    const wchar_t* state = PowermateManager::IsConnected() ? L"present" : L"absent";
+
+    if (expectedState && wcscmp(expectedState, state) != 0) {
+        wprintf(L"[Bench] Device is %ls, expected %ls\n", state, expectedState);
+        return -1;
+    }
+
+    // Let startup work settle before sampling
+    if (!PumpMessagesFor(2000)) {
+        wprintf(L"[Bench] Aborted: application exited before sampling\n");
+        return -1;
+    }
+
+    HANDLE reader = PowermateManager::GetInputThreadHandle();
+    HANDLE pacer = OutputPacer::GetFlushThreadHandle();
+
+    wprintf(L"[Bench] Idling %lu s with the device %ls, do not touch the knob\n", durationMs / 1000, state);
+    fflush(stdout);
+
+    IdleSample before = TakeSample(reader, pacer);
+    bool completed = PumpMessagesFor(durationMs);
+    IdleSample after = TakeSample(reader, pacer);
+
+    // Rates use the measured interval, a run cut short says nothing about a minute
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    double elapsedMs = (after.counter - before.counter) * 1000.0 / frequency.QuadPart;
+    if (!completed || elapsedMs < durationMs * 0.99) {
+        wprintf(L"[Bench] Aborted: application exited after %.1f of %lu s\n", elapsedMs / 1000.0, durationMs / 1000);
+        return -1;
+    }
+    double minutes = elapsedMs / 60000.0;
+    ULONG readerWakeups = after.switches.reader - before.switches.reader;
+    ULONG pacerWakeups = after.switches.pacer - before.switches.pacer;
+    ULONG64 processWakeups = after.switches.process - before.switches.process;
+    double cpuMs = (after.cpuTime - before.cpuTime) / 10000.0;
+
+    wprintf(L"[Bench] reader: %ls, %lu wakeups, %llu cycles\n", reader ? L"running" : L"not running",
+            readerWakeups, after.readerCycles - before.readerCycles);
+    wprintf(L"[Bench] pacer:  %ls, %lu wakeups, %llu cycles\n", pacer ? L"running" : L"not running",
+            pacerWakeups, after.pacerCycles - before.pacerCycles);
+    wprintf(L"[Bench] process: %llu wakeups, %.2f ms CPU per minute over %.1f s\n", processWakeups, cpuMs / minutes, elapsedMs / 1000.0);
+
+    bool withinBudget = readerWakeups / minutes <= ThreadWakeupBudget &&
+                        pacerWakeups / minutes <= ThreadWakeupBudget &&
+                        processWakeups / minutes <= ProcessWakeupBudget &&
+                        cpuMs / minutes <= CpuBudgetMs;
+
+    wprintf(L"[Bench] %ls (budget: %lu wakeups per thread, %lu per process, %.0f ms CPU per minute)\n",
+            withinBudget ? L"PASS" : L"FAIL", ThreadWakeupBudget, ProcessWakeupBudget, CpuBudgetMs);
+    return withinBudget ? 0 : 1;
+}
+
+// Compare wakeup jitter with and without low-latency mode under full CPU load
+int Benchmark::RunJitter() {
+    unsigned int cores = std::max<DWORD>(1, GetActiveProcessorCount(ALL_PROCESSOR_GROUPS));
+    wprintf(L"[Bench] Saturating %u cores, %zu wakeups per pass\n", cores, JitterSamples);
+    fflush(stdout);
+
+    std::atomic<bool> loaded(true);
+    std::vector<std::thread> load;
+    for (unsigned int i = 0; i < cores; ++i) {
+        load.emplace_back([&loaded]() {
+            while (loaded.load(std::memory_order_relaxed)) {}
+        });
+    }
+
+    LowLatency::Configure(false, 0, false);
+    PrintPercentiles(L"default", MeasureWakeups(JitterSamples));
+
+    LowLatency::Configure(true, 0, false);
+    PrintPercentiles(L"-lowlatency", MeasureWakeups(JitterSamples));
+
+    loaded.store(false);
+    for (std::thread& t : load) {
+        t.join();
+    }
+    return 0;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <Windows.h>
+
+class Benchmark {
+public:
+    // Idle the running application for a minute and check the wakeup budget.
+    // expectedState is L"absent", L"present" or nullptr to accept either.
+    // Returns 0 within budget, 1 over budget, -1 if the device state does not match
+    // or the application quit before the minute was over.
+    static int RunIdle(const wchar_t* expectedState);
+
+    // Time event signal to thread wakeup while every core is busy, first at
+    // default priority and then in low-latency mode, and print percentiles.
+    static int RunJitter();
+
+private:
+    // Wakeup and CPU budget for one idle minute
+    static constexpr ULONG ThreadWakeupBudget = 2;      // Reader and pacer threads, each
+    static constexpr ULONG ProcessWakeupBudget = 120;   // All threads of the process
+    static constexpr double CpuBudgetMs = 50.0;         // User + kernel time of the process
+
+    // Wakeups timed per jitter pass, one every millisecond
+    static constexpr size_t JitterSamples = 5000;
+
+    // Keep the tray window responsive while waiting, returns false on WM_QUIT
+    static bool PumpMessagesFor(DWORD milliseconds);
+};
@@ -0,0 +1,381 @@
+#include "FlightRecorder.h"
+#include "ProfileManager.h"
+#include "LowLatency.h"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+// Static variable definitions
+HANDLE FlightRecorder::hFile = INVALID_HANDLE_VALUE;
+HANDLE FlightRecorder::hMapping = nullptr;
+FlightRecorder::Header* FlightRecorder::header = nullptr;
+FlightRecorder::Record* FlightRecorder::records = nullptr;
+LPTOP_LEVEL_EXCEPTION_FILTER FlightRecorder::previousFilter = nullptr;
+wchar_t FlightRecorder::crashDumpDir[MAX_PATH] = {};
+
+namespace {
+
+const char* StateName(uint8_t state) {
+    switch (state) {
+        case STATE_CONNECTED:    return "CONNECTED";
+        case STATE_DISCONNECTED: return "DISCONNECTED";
+        case STATE_SUSPEND:      return "SUSPEND";
+        case STATE_RESUME:       return "RESUME";
+        case STATE_READ_ERROR:   return "READ_ERROR";
+        case STATE_STOPPED:      return "STOPPED";
+        default:                 return "UNKNOWN";
+    }
+}
+
+// Format a FILETIME as local "YYYY-MM-DD hh:mm:ss.uuuuuu"
+std::string FormatTime(uint64_t fileTime) {
+    FILETIME ft;
+    ft.dwLowDateTime = static_cast<DWORD>(fileTime);
+    ft.dwHighDateTime = static_cast<DWORD>(fileTime >> 32);
+
+    SYSTEMTIME utc, local;
+    FileTimeToSystemTime(&ft, &utc);
+    SystemTimeToTzSpecificLocalTime(nullptr, &utc, &local);
+
+    char text[64];
+    snprintf(text, sizeof(text), "%04u-%02u-%02u %02u:%02u:%02u.%06llu",
+             local.wYear, local.wMonth, local.wDay, local.wHour, local.wMinute, local.wSecond,
+             (fileTime % 10000000) / 10);
+    return text;
+}
+
+// Convert a tick difference to 100ns units without overflowing on long sessions
+int64_t TicksToFileTime(int64_t ticks, int64_t frequency) {
+    return (ticks / frequency) * 10000000 + (ticks % frequency) * 10000000 / frequency;
+}
+
+}  // namespace
+
+// Location of the ring file
+std::wstring FlightRecorder::GetRingPath() {
+    wchar_t dir[MAX_PATH];
+    DWORD len = GetTempPathW(MAX_PATH, dir);
+    if (len == 0 || len > MAX_PATH) return L"PowerMateControl.flight";
+    return std::wstring(dir) + L"PowerMateControl.flight";
+}
+
+// Timestamped location for on-demand and crash dumps
+std::wstring FlightRecorder::GetDumpPath() {
+    SYSTEMTIME t;
+    GetLocalTime(&t);
+    wchar_t name[64];
+    swprintf_s(name, L"PowerMateControl-%04u%02u%02u-%02u%02u%02u.flight",
+               t.wYear, t.wMonth, t.wDay, t.wHour, t.wMinute, t.wSecond);
+
+    wchar_t dir[MAX_PATH];
+    DWORD len = GetTempPathW(MAX_PATH, dir);
+    if (len == 0 || len > MAX_PATH) return name;
+    return std::wstring(dir) + name;
+}
+
+// Map the ring file into memory
+bool FlightRecorder::Open() {
+    if (header) return true;
+
+    const DWORD fileSize = sizeof(Header) + Capacity * sizeof(Record);
+    std::wstring path = GetRingPath();
+
+    hFile = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+                        nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        std::cerr << "[Error] Failed to open flight recorder file\n";
+        return false;
+    }
+
+    hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READWRITE, 0, fileSize, nullptr);
+    if (!hMapping) {
+        std::cerr << "[Error] Failed to map flight recorder file\n";
+        CloseHandle(hFile);
+        hFile = INVALID_HANDLE_VALUE;
+        return false;
+    }
+
+    void* view = MapViewOfFile(hMapping, FILE_MAP_ALL_ACCESS, 0, 0, fileSize);
+    if (!view) {
+        std::cerr << "[Error] Failed to map flight recorder view\n";
+        CloseHandle(hMapping);
+        CloseHandle(hFile);
+        hMapping = nullptr;
+        hFile = INVALID_HANDLE_VALUE;
+        return false;
+    }
+
+    Header* h = static_cast<Header*>(view);
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+
+    // Start over if the file is new or was written by another layout
+    if (h->magic != Magic || h->version != Version || h->capacity != Capacity ||
+        h->recordSize != sizeof(Record) || h->frequency != frequency.QuadPart) {
+        memset(view, 0, fileSize);
+        h->magic = Magic;
+        h->version = Version;
+        h->capacity = Capacity;
+        h->recordSize = sizeof(Record);
+        h->frequency = frequency.QuadPart;
+    }
+
+    records = reinterpret_cast<Record*>(h + 1);
+    header = h;
+    LowLatency::LockRegion(view, fileSize);
+
+    // Anchor the tick counter to the wall clock for the decoder, keeping the
+    // previous anchor in the session record for the records written before it
+    Anchor previous = { h->anchorTime, h->anchorTicks };
+    FILETIME now;
+    LARGE_INTEGER ticks;
+    GetSystemTimePreciseAsFileTime(&now);
+    QueryPerformanceCounter(&ticks);
+    h->anchorTime = (static_cast<uint64_t>(now.dwHighDateTime) << 32) | now.dwLowDateTime;
+    h->anchorTicks = static_cast<uint64_t>(ticks.QuadPart);
+    Write(RECORD_SESSION, &previous, sizeof(previous));
+
+    // No allocation is possible once the process is crashing, the name is completed there
+    DWORD dirLength = GetTempPathW(MAX_PATH, crashDumpDir);
+    if (dirLength == 0 || dirLength > MAX_PATH) crashDumpDir[0] = L'\0';
+    previousFilter = SetUnhandledExceptionFilter(&FlightRecorder::OnCrash);
+
+    std::cerr << "[Debug] Flight recorder ready\n";
+    return true;
+}
+
+// Flush and release the mapping
+void FlightRecorder::Close() {
+    if (!header) return;
+
+    SetUnhandledExceptionFilter(previousFilter);
+    previousFilter = nullptr;
+
+    Header* h = header;
+    header = nullptr;
+    records = nullptr;
+
+    FlushViewOfFile(h, 0);
+    UnmapViewOfFile(h);
+    CloseHandle(hMapping);
+    CloseHandle(hFile);
+    hMapping = nullptr;
+    hFile = INVALID_HANDLE_VALUE;
+}
+
+// Reserve the next slot and fill it
+void FlightRecorder::Write(uint8_t type, const void* data, size_t size) {
+    Header* h = header;
+    if (!h) return;
+
+    uint64_t index = h->next.fetch_add(1, std::memory_order_relaxed);
+    Record& r = records[index & (Capacity - 1)];
+
+    // Readers ignore the slot until the matching sequence is published
+    r.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    r.ticks = static_cast<uint64_t>(now.QuadPart);
+    r.type = type;
+    r.size = static_cast<uint8_t>(size < sizeof(r.data) ? size : sizeof(r.data));
+    memcpy(r.data, data, r.size);
+
+    r.sequence.store(static_cast<uint32_t>(index + 1), std::memory_order_release);
+}
+
+void FlightRecorder::RecordReport(const unsigned char* data, DWORD size) {
+    Write(RECORD_REPORT, data, size);
+}
+
+void FlightRecorder::RecordState(FlightStateEvent state, uint32_t value) {
+    uint8_t data[5] = { state };
+    memcpy(data + 1, &value, sizeof(value));
+    Write(RECORD_STATE, data, sizeof(data));
+}
+
+void FlightRecorder::RecordProfile(size_t index) {
+    uint32_t value = static_cast<uint32_t>(index);
+    Write(RECORD_PROFILE, &value, sizeof(value));
+}
+
+// Write a snapshot of the mapped ring to a separate file
+bool FlightRecorder::Dump(const std::wstring& path) {
+    return DumpTo(path.c_str());
+}
+
+// Snapshot the ring with a seqlock read of every slot, then write it out
+bool FlightRecorder::DumpTo(const wchar_t* path) {
+    Header* h = header;
+    if (!h) return false;
+
+    const DWORD fileSize = sizeof(Header) + Capacity * sizeof(Record);
+    unsigned char* snapshot = static_cast<unsigned char*>(
+        VirtualAlloc(nullptr, fileSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+    if (!snapshot) return false;
+
+    // Slots published after this point fail the decoder's sequence check
+    uint64_t next = h->next.load(std::memory_order_acquire);
+    memcpy(snapshot, h, sizeof(Header));
+    memcpy(snapshot + offsetof(Header, next), &next, sizeof(next));
+
+    for (uint32_t i = 0; i < Capacity; ++i) {
+        const Record& r = records[i];
+        unsigned char* slot = snapshot + sizeof(Header) + i * sizeof(Record);
+
+        uint32_t before = r.sequence.load(std::memory_order_acquire);
+        memcpy(slot, &r, sizeof(Record));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint32_t after = r.sequence.load(std::memory_order_relaxed);
+
+        // Keep the slot only if no writer touched it during the copy
+        if (before == 0 || before != after) {
+            memset(slot, 0, sizeof(Record));
+        }
+    }
+
+    HANDLE out = CreateFileW(path, GENERIC_WRITE, 0, nullptr,
+                             CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    DWORD written = 0;
+    BOOL ok = out != INVALID_HANDLE_VALUE && WriteFile(out, snapshot, fileSize, &written, nullptr);
+    if (out != INVALID_HANDLE_VALUE) CloseHandle(out);
+    VirtualFree(snapshot, 0, MEM_RELEASE);
+
+    return ok && written == fileSize;
+}
+
+// Save the ring next to the live file before the process dies
+LONG WINAPI FlightRecorder::OnCrash(EXCEPTION_POINTERS* info) {
+    if (header) {
+        FlushViewOfFile(header, 0);
+
+        // Named after the crash time, formatted on the stack
+        SYSTEMTIME t;
+        GetLocalTime(&t);
+        wchar_t path[MAX_PATH + 64];
+        if (swprintf_s(path, L"%lsPowerMateControl-%04u%02u%02u-%02u%02u%02u.flight", crashDumpDir,
+                       t.wYear, t.wMonth, t.wDay, t.wHour, t.wMinute, t.wSecond) > 0) {
+            DumpTo(path);
+        }
+    }
+    return previousFilter ? previousFilter(info) : EXCEPTION_CONTINUE_SEARCH;
+}
+
+// Decode a ring or dump file into a text timeline, oldest record first
+bool FlightRecorder::Decode(const std::wstring& dumpPath, const std::wstring& outPath) {
+    std::ifstream in(dumpPath, std::ios::binary);
+    if (!in) return false;
+    std::vector<char> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (file.size() < sizeof(Header)) return false;
+
+    const Header* h = reinterpret_cast<const Header*>(file.data());
+    if (h->magic != Magic || h->version != Version || h->recordSize != sizeof(Record) ||
+        h->capacity == 0 || (h->capacity & (h->capacity - 1)) != 0 || h->frequency <= 0 ||
+        file.size() < sizeof(Header) + static_cast<size_t>(h->capacity) * sizeof(Record)) {
+        return false;
+    }
+
+    std::ofstream out(outPath);
+    if (!out) return false;
+
+    const Record* ring = reinterpret_cast<const Record*>(h + 1);
+    uint64_t next = h->next.load();
+    uint64_t first = next > h->capacity ? next - h->capacity : 0;
+    size_t skipped = 0;
+
+    // Collect intact records, oldest first
+    std::vector<const Record*> timeline;
+    for (uint64_t i = first; i < next; ++i) {
+        const Record& r = ring[i & (h->capacity - 1)];
+        if (r.sequence.load() != static_cast<uint32_t>(i + 1)) {
+            ++skipped; // Torn or overwritten while dumping
+            continue;
+        }
+        timeline.push_back(&r);
+    }
+
+    // Walk back from the header anchor: each session record holds the anchor
+    // of the session before it, so older records stay anchored after restarts
+    std::vector<Anchor> anchors(timeline.size());
+    Anchor anchor = { h->anchorTime, h->anchorTicks };
+    for (size_t i = timeline.size(); i-- > 0;) {
+        anchors[i] = anchor;
+        const Record& r = *timeline[i];
+        if (r.type == RECORD_SESSION && r.size >= sizeof(Anchor)) {
+            memcpy(&anchor, r.data, sizeof(Anchor));
+        }
+    }
+
+    const auto& profiles = ProfileManager::GetProfileList();
+    char line[160];
+
+    for (size_t i = 0; i < timeline.size(); ++i) {
+        const Record& r = *timeline[i];
+        bool anchored = anchors[i].time != 0;
+        int64_t elapsed = TicksToFileTime(static_cast<int64_t>(r.ticks - anchors[i].ticks), h->frequency);
+
+        if (r.type == RECORD_SESSION) {
+            out << "---- session started "
+                << (anchored ? FormatTime(anchors[i].time + elapsed) : std::string("(unknown time)")) << " ----\n";
+            continue;
+        }
+
+        if (anchored) {
+            out << FormatTime(anchors[i].time + elapsed);
+        } else {
+            out << "????-??-?? ??:??:??.??????";
+        }
+
+        // Ticks are only comparable within a session
+        bool sameSession = i > 0 && anchors[i - 1].time == anchors[i].time &&
+                           anchors[i - 1].ticks == anchors[i].ticks;
+        double delta = sameSession ? static_cast<int64_t>(r.ticks - timeline[i - 1]->ticks) /
+                                     static_cast<double>(h->frequency) : 0.0;
+        snprintf(line, sizeof(line), "  +%.6fs  ", delta);
+        out << line;
+
+        switch (r.type) {
+            case RECORD_REPORT: {
+                out << "REPORT ";
+                for (uint8_t b = 0; b < r.size; ++b) {
+                    snprintf(line, sizeof(line), " %02X", r.data[b]);
+                    out << line;
+                }
+                if (r.size >= 3) {
+                    snprintf(line, sizeof(line), "  button=%u rotation=%d",
+                             r.data[1], static_cast<int8_t>(r.data[2]));
+                    out << line;
+                }
+                break;
+            }
+            case RECORD_STATE: {
+                uint32_t value = 0;
+                if (r.size >= 5) memcpy(&value, r.data + 1, sizeof(value));
+                out << "STATE   " << StateName(r.data[0]);
+                if (r.data[0] == STATE_READ_ERROR) out << " error=" << value;
+                break;
+            }
+            case RECORD_PROFILE: {
+                uint32_t index = 0;
+                if (r.size >= sizeof(index)) memcpy(&index, r.data, sizeof(index));
+                out << "PROFILE " << index;
+                if (index < profiles.size()) {
+                    out << " (" << std::string(profiles[index].begin(), profiles[index].end()) << ")";
+                }
+                break;
+            }
+            default:
+                out << "UNKNOWN type=" << static_cast<int>(r.type);
+                break;
+        }
+        out << "\n";
+    }
+
+    out << "---- " << timeline.size() << " records, " << skipped << " skipped ----\n";
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <Windows.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Kind of event stored in a flight recorder record
+enum FlightRecordType : uint8_t {
+    RECORD_EMPTY,       // Slot never written
+    RECORD_REPORT,      // Raw HID report from the input loop
+    RECORD_STATE,       // Connection state transition
+    RECORD_PROFILE,     // Profile switch
+    RECORD_SESSION,     // Recorder opened, data holds the anchor of the previous session
+};
+
+// Connection state transitions stored in RECORD_STATE records
+enum FlightStateEvent : uint8_t {
+    STATE_CONNECTED,    // Device opened
+    STATE_DISCONNECTED, // Device removed or read failed
+    STATE_SUSPEND,      // System suspending
+    STATE_RESUME,       // System resumed
+    STATE_READ_ERROR,   // ReadFile failed, value holds GetLastError()
+    STATE_STOPPED,      // Input thread stopped and device closed
+};
+
+class FlightRecorder {
+public:
+    // Map the ring file, keeping any records left by a previous run
+    static bool Open();
+
+    // Flush and unmap the ring file
+    static void Close();
+
+    // Hot path recorders: no syscalls, safe to call from any thread
+    static void RecordReport(const unsigned char* data, DWORD size);
+    static void RecordState(FlightStateEvent state, uint32_t value = 0);
+    static void RecordProfile(size_t index);
+
+    // Copy the current ring to a standalone dump file
+    static bool Dump(const std::wstring& path);
+
+    // Turn a ring or dump file into a readable text timeline
+    static bool Decode(const std::wstring& dumpPath, const std::wstring& outPath);
+
+    // Default location of the ring file and of on-demand dumps
+    static std::wstring GetRingPath();
+    static std::wstring GetDumpPath();
+
+private:
+    // One fixed-size slot in the ring
+    struct Record {
+        uint64_t ticks;                 // QueryPerformanceCounter value
+        std::atomic<uint32_t> sequence; // Written last, 0 while the slot is being filled
+        uint8_t type;                   // FlightRecordType
+        uint8_t size;                   // Bytes used in data
+        uint16_t reserved;
+        uint8_t data[16];
+    };
+    static_assert(sizeof(Record) == 32, "Record layout is part of the file format");
+
+    // File header, followed by the ring of records
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t capacity;              // Number of records, power of two
+        uint32_t recordSize;
+        int64_t frequency;              // QueryPerformanceFrequency value
+        std::atomic<uint64_t> next;     // Total number of records ever reserved
+        uint64_t anchorTime;            // FILETIME when the current session was opened
+        uint64_t anchorTicks;           // QueryPerformanceCounter value at anchorTime
+    };
+
+    // Wall clock anchor of a session, stored in RECORD_SESSION data
+    struct Anchor {
+        uint64_t time;
+        uint64_t ticks;
+    };
+
+    static constexpr uint32_t Magic = 0x52464D50;   // "PMFR"
+    static constexpr uint32_t Version = 2;
+    static constexpr uint32_t Capacity = 16384;
+
+    // Reserve a slot and fill it, publishing the sequence number last
+    static void Write(uint8_t type, const void* data, size_t size);
+
+    // Copy the ring slot by slot, dropping slots rewritten during the copy.
+    // Allocates outside the CRT heap so it is usable from the crash hook.
+    static bool DumpTo(const wchar_t* path);
+
+    // Crash hook making sure the ring reaches the disk
+    static LONG WINAPI OnCrash(EXCEPTION_POINTERS* info);
+
+    static HANDLE hFile;
+    static HANDLE hMapping;
+    static Header* header;
+    static Record* records;
+    static LPTOP_LEVEL_EXCEPTION_FILTER previousFilter;
+    static wchar_t crashDumpDir[MAX_PATH];  // Temp directory with a trailing backslash, or empty
+};
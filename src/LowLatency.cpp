@@ -0,0 +1,89 @@
+#include "LowLatency.h"
+#include <avrt.h>
+#include <malloc.h>
+#include <iostream>
+
+#pragma comment(lib, "Avrt.lib")
+
+// Static variable definitions
+bool LowLatency::enabled = false;
+DWORD_PTR LowLatency::affinityMask = 0;
+bool LowLatency::lockMemory = false;
+
+// Store options and apply process-wide settings
+void LowLatency::Configure(bool enable, DWORD_PTR mask, bool lock) {
+    enabled = enable;
+    affinityMask = mask;
+    lockMemory = false;
+
+    if (lock) {
+        // VirtualLock can only pin as much as the minimum working set allows
+        const SIZE_T minimumSize = 16 * 1024 * 1024;
+        const SIZE_T maximumSize = 64 * 1024 * 1024;
+        if (SetProcessWorkingSetSizeEx(GetCurrentProcess(), minimumSize, maximumSize,
+                                       QUOTA_LIMITS_HARDWS_MIN_ENABLE | QUOTA_LIMITS_HARDWS_MAX_DISABLE)) {
+            lockMemory = true;
+            std::cerr << "[Debug] Working set floor raised for memory locking\n";
+        } else {
+            std::cerr << "[Error] Failed to raise working set floor: " << GetLastError() << "\n";
+        }
+    }
+}
+
+// Touch every page so it is committed and resident, then pin it
+void LowLatency::LockRegion(void* address, SIZE_T size) {
+    if (!lockMemory || !address || size == 0) return;
+
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    volatile BYTE* bytes = static_cast<volatile BYTE*>(address);
+    for (SIZE_T offset = 0; offset < size; offset += info.dwPageSize) {
+        bytes[offset] = bytes[offset];
+    }
+
+    if (!VirtualLock(address, size)) {
+        std::cerr << "[Error] Failed to lock memory: " << GetLastError() << "\n";
+    }
+}
+
+// Stack pages stay committed once probed, so lock them from a temporary frame
+void LowLatency::LockCurrentStack() {
+    void* region = _alloca(StackLockSize);
+    LockRegion(region, StackLockSize);
+}
+
+// Raise the calling thread to time-critical priority
+HANDLE LowLatency::ApplyToCurrentThread() {
+    if (lockMemory) {
+        LockCurrentStack();
+    }
+
+    if (affinityMask != 0 && !SetThreadAffinityMask(GetCurrentThread(), affinityMask)) {
+        std::cerr << "[Error] Failed to set thread affinity: " << GetLastError() << "\n";
+    }
+
+    if (!enabled) return nullptr;
+
+    // Prefer MMCSS so the scheduler boosts us even under full CPU load
+    DWORD taskIndex = 0;
+    HANDLE task = AvSetMmThreadCharacteristicsW(L"Pro Audio", &taskIndex);
+    if (task) {
+        AvSetMmThreadPriority(task, AVRT_PRIORITY_CRITICAL);
+        std::cerr << "[Debug] Thread joined MMCSS task\n";
+        return task;
+    }
+
+    if (!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL)) {
+        std::cerr << "[Error] Failed to raise thread priority: " << GetLastError() << "\n";
+    } else {
+        std::cerr << "[Debug] Thread priority set to time critical\n";
+    }
+    return nullptr;
+}
+
+// Leave the MMCSS task
+void LowLatency::RevertCurrentThread(HANDLE mmcssTask) {
+    if (mmcssTask) {
+        AvRevertMmThreadCharacteristics(mmcssTask);
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <Windows.h>
+
+class LowLatency {
+public:
+    // Select the options applied to the reader and dispatcher threads
+    static void Configure(bool enable, DWORD_PTR mask, bool lock);
+
+    // Raise the calling thread priority, returns the MMCSS handle to revert (or nullptr)
+    static HANDLE ApplyToCurrentThread();
+
+    // Leave the MMCSS task joined by ApplyToCurrentThread
+    static void RevertCurrentThread(HANDLE mmcssTask);
+
+    // Touch and lock a buffer used on the input path, when memory locking is on
+    static void LockRegion(void* address, SIZE_T size);
+
+private:
+    // Touch and lock the top of the calling thread stack
+    static void LockCurrentStack();
+
+    // Stack bytes locked for each input thread, enough for the whole input path
+    static constexpr SIZE_T StackLockSize = 64 * 1024;
+
+    // Options set from the command line
+    static bool enabled;
+    static DWORD_PTR affinityMask;
+    static bool lockMemory;
+};
@@ -0,0 +1,152 @@
+#include "OutputPacer.h"
+#include "ProfileManager.h"
+#include "LowLatency.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+// Static variable definitions
+PacerCore OutputPacer::core(&OutputPacer::Now, &TriggerAction::HandleRotation);
+std::thread OutputPacer::flushThread;
+HANDLE OutputPacer::hTimer = nullptr;
+HANDLE OutputPacer::hStopEvent = nullptr;
+std::mutex OutputPacer::pacerMutex;
+
+// Current time in 100ns units
+int64_t OutputPacer::Now() {
+    using Ticks = std::chrono::duration<int64_t, std::ratio<1, 10000000>>;
+    return std::chrono::duration_cast<Ticks>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Refresh rate of the primary display
+unsigned int OutputPacer::GetDisplayRefreshRate() {
+    DEVMODEW mode = {};
+    mode.dmSize = sizeof(mode);
+    if (EnumDisplaySettingsW(nullptr, ENUM_CURRENT_SETTINGS, &mode) && mode.dmDisplayFrequency > 1) {
+        return mode.dmDisplayFrequency;
+    }
+    return 60; // 0 and 1 mean hardware default
+}
+
+// Native handle of the flush thread
+HANDLE OutputPacer::GetFlushThreadHandle() {
+    return flushThread.joinable() ? flushThread.native_handle() : nullptr;
+}
+
+// Start the pacing stage
+void OutputPacer::Start(unsigned int rateHz) {
+    std::lock_guard<std::mutex> lock(pacerMutex);
+    if (flushThread.joinable() || core.GetPeriod() != 0) return;
+
+    if (rateHz == 0) {
+        std::cerr << "[Debug] Output pacing disabled\n";
+        return;
+    }
+
+    hTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (!hTimer) {
+        hTimer = CreateWaitableTimerW(nullptr, FALSE, nullptr); // Before Windows 10 1803
+    }
+    hStopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!hTimer || !hStopEvent) {
+        std::cerr << "[Error] Failed to create pacing timer, pacing disabled\n";
+        if (hTimer) CloseHandle(hTimer);
+        if (hStopEvent) CloseHandle(hStopEvent);
+        hTimer = hStopEvent = nullptr;
+        return;
+    }
+
+    core.SetPeriod(10000000 / rateHz);
+    flushThread = std::thread(&OutputPacer::FlushLoop);
+    std::cerr << "[Debug] Output pacing at " << rateHz << " Hz\n";
+}
+
+// Stop the pacing stage
+void OutputPacer::Stop() {
+    if (hStopEvent) SetEvent(hStopEvent);
+    if (flushThread.joinable()) {
+        flushThread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(pacerMutex);
+    core.Disable();
+
+    if (hTimer) CloseHandle(hTimer);
+    if (hStopEvent) CloseHandle(hStopEvent);
+    hTimer = hStopEvent = nullptr;
+
+    std::cerr << "[Debug] Output pacer: " << core.GetReportCount() << " inputs, "
+              << core.GetInjectionCount() << " injections ("
+              << core.GetRotationEventCount() << " rotation events), "
+              << core.GetInjectedSteps() << " of " << core.GetSubmittedSteps() << " steps sent\n";
+    PrintLatency();
+}
+
+// Log report arrival to SendInput percentiles, to compare pacing rates
+void OutputPacer::PrintLatency() {
+    if (core.GetLatencies().empty()) return;
+
+    std::vector<int64_t> sorted(core.GetLatencies());
+    std::sort(sorted.begin(), sorted.end());
+    auto at = [&](double p) { return sorted[static_cast<size_t>(p * (sorted.size() - 1))] / 10000.0; };
+
+    char line[160];
+    snprintf(line, sizeof(line), "[Debug] Output latency: p50 %.2f ms, p90 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+             at(0.50), at(0.90), at(0.99), sorted.back() / 10000.0);
+    std::cerr << line;
+}
+
+// Queue an input event
+void OutputPacer::Submit(PowermateInputType inputType, int64_t arrival) {
+    if (inputType == PowermateInputType::ROTATE_LEFT || inputType == PowermateInputType::ROTATE_RIGHT) {
+        SubmitRotation(inputType == PowermateInputType::ROTATE_LEFT ? 1 : -1, arrival);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(pacerMutex);
+
+    // Buttons go out immediately, after any rotation that came before them
+    if (core.IsArmed()) {
+        CancelWaitableTimer(hTimer);
+    }
+    core.SubmitButton(arrival, [inputType] { TriggerAction::HandleAction(inputType); });
+}
+
+// Queue rotation steps
+void OutputPacer::SubmitRotation(int steps, int64_t arrival) {
+    std::lock_guard<std::mutex> lock(pacerMutex);
+    int64_t delay = core.SubmitRotation(ProfileManager::GetCurrentProfileIndex(), steps, arrival);
+    if (delay == 0) return;
+
+    LARGE_INTEGER dueTime;
+    dueTime.QuadPart = -delay; // Relative, in 100ns units
+    if (!SetWaitableTimer(hTimer, &dueTime, 0, nullptr, nullptr, FALSE)) {
+        core.OnDeadline();
+    }
+}
+
+// Flush rotation each time a deadline expires
+void OutputPacer::FlushLoop() {
+    HANDLE handles[2] = { hStopEvent, hTimer };
+    HANDLE mmcssTask = LowLatency::ApplyToCurrentThread();
+
+    for (;;) {
+        DWORD result = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+        if (result == WAIT_OBJECT_0) break; // Stop requested
+        DWORD err = GetLastError();
+
+        std::lock_guard<std::mutex> lock(pacerMutex);
+        if (result != WAIT_OBJECT_0 + 1) {
+            // Without the timer nothing would send pending rotation, fall back to pass-through
+            std::cerr << "[Error] Pacing timer wait failed (" << result << ", " << err
+                      << "), sending one injection per report\n";
+            core.Disable();
+            break;
+        }
+
+        core.OnDeadline();
+    }
+
+    LowLatency::RevertCurrentThread(mmcssTask);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "PacerCore.h"
+#include "TriggerAction.h"
+#include <Windows.h>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+class OutputPacer {
+public:
+    // Start pacing rotation at the given rate in Hz (0 sends one injection per report)
+    static void Start(unsigned int rateHz);
+
+    // Flush pending rotation and stop the flush thread
+    static void Stop();
+
+    // Queue an input event: rotation is coalesced, buttons are sent immediately.
+    // arrival is the Now() time the report was read, for latency statistics.
+    static void Submit(PowermateInputType inputType, int64_t arrival);
+
+    // Queue signed rotation steps from one report (positive is ROTATE_LEFT)
+    static void SubmitRotation(int steps, int64_t arrival);
+
+    // Current time in 100ns units, the waitable timer resolution
+    static int64_t Now();
+
+    // Refresh rate of the primary display, used as the default pacing rate
+    static unsigned int GetDisplayRefreshRate();
+
+    // Native handle of the flush thread while pacing, for benchmarks
+    static HANDLE GetFlushThreadHandle();
+
+private:
+    // Waits for flush deadlines on the timer
+    static void FlushLoop();
+
+    // Latency percentiles logged on Stop()
+    static void PrintLatency();
+
+    // Accumulation, flush deadlines and statistics, pacerMutex must be held
+    static PacerCore core;
+
+    // Flush thread, its timer and stop event
+    static std::thread flushThread;
+    static HANDLE hTimer;
+    static HANDLE hStopEvent;
+    static std::mutex pacerMutex;
+};
@@ -0,0 +1,103 @@
+#include "PacerCore.h"
+#include <utility>
+
+PacerCore::PacerCore(Clock clock, InjectRotation inject)
+    : clock(std::move(clock)), inject(std::move(inject)) {}
+
+void PacerCore::SetPeriod(int64_t newPeriod) {
+    Flush();
+    period = newPeriod;
+    armed = false;
+    lastFlush = 0;
+}
+
+// Queue rotation steps
+int64_t PacerCore::SubmitRotation(size_t profileIndex, int steps, int64_t arrival) {
+    if (steps == 0) return 0;
+
+    ++reportCount;
+    submittedSteps += steps;
+
+    // Pass-through: one injection per report
+    if (period == 0) {
+        rotationEventCount += inject(profileIndex, steps);
+        ++injectionCount;
+        injectedSteps += steps;
+        RecordLatency(arrival, clock());
+        return 0;
+    }
+
+    if (profileIndex >= pending.size()) {
+        pending.resize(profileIndex + 1, 0);
+    }
+    pending[profileIndex] += steps;
+    pendingArrivals.push_back(arrival);
+
+    if (armed) return 0;
+
+    // Send right away after an idle period, otherwise wait for the next deadline
+    int64_t now = clock();
+    int64_t deadline = lastFlush + period;
+    if (now >= deadline) {
+        Flush();
+        return 0;
+    }
+
+    armed = true;
+    return deadline - now;
+}
+
+// Buttons go out immediately, after any rotation that came before them
+void PacerCore::SubmitButton(int64_t arrival, const std::function<void()>& send) {
+    ++reportCount;
+    armed = false;
+    Flush();
+    send();
+    ++injectionCount;
+    RecordLatency(arrival, clock());
+}
+
+void PacerCore::OnDeadline() {
+    if (!armed) return; // Already flushed by a button event
+    armed = false;
+    Flush();
+}
+
+void PacerCore::Disable() {
+    armed = false;
+    Flush();
+    period = 0;
+}
+
+// Send accumulated rotation
+void PacerCore::Flush() {
+    bool flushed = false;
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (pending[i] == 0) continue;
+        rotationEventCount += inject(i, pending[i]);
+        ++injectionCount;
+        injectedSteps += pending[i];
+        pending[i] = 0;
+        flushed = true;
+    }
+
+    int64_t sent = clock();
+    if (flushed) {
+        lastFlush = sent;
+    }
+
+    for (int64_t arrival : pendingArrivals) {
+        RecordLatency(arrival, sent);
+    }
+    pendingArrivals.clear();
+}
+
+// Store one latency sample, oldest overwritten first
+void PacerCore::RecordLatency(int64_t arrival, int64_t sent) {
+    if (latencies.size() < MaxLatencySamples) {
+        latencies.push_back(sent - arrival);
+    } else {
+        latencies[latencyCount % MaxLatencySamples] = sent - arrival;
+    }
+    ++latencyCount;
+}
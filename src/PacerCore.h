@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Rotation coalescing used by OutputPacer: pending steps per profile, flush
+// deadlines and statistics. Kept free of platform headers, with the clock and
+// the injection injected, so scripted report streams can drive it.
+// Not thread-safe, OutputPacer calls it under its mutex.
+class PacerCore {
+public:
+    // Current time in 100ns units
+    using Clock = std::function<int64_t()>;
+
+    // Send rotation steps for a profile (positive is ROTATE_LEFT),
+    // returns the number of input events inserted
+    using InjectRotation = std::function<unsigned int(size_t profileIndex, int steps)>;
+
+    PacerCore(Clock clock, InjectRotation inject);
+
+    // Pacing period in 100ns units, 0 sends one injection per report
+    void SetPeriod(int64_t newPeriod);
+    int64_t GetPeriod() const { return period; }
+
+    // A deadline returned by SubmitRotation() is still outstanding
+    bool IsArmed() const { return armed; }
+
+    // Queue rotation from one report. Returns the delay in 100ns units after
+    // which OnDeadline() must be called, or 0 when nothing has to be scheduled.
+    int64_t SubmitRotation(size_t profileIndex, int steps, int64_t arrival);
+
+    // Send pending rotation, then the button through send, keeping their order
+    void SubmitButton(int64_t arrival, const std::function<void()>& send);
+
+    // The scheduled deadline was reached
+    void OnDeadline();
+
+    // Deadlines can no longer be scheduled: flush and fall back to pass-through
+    void Disable();
+
+    // Send all pending rotation
+    void Flush();
+
+    // Statistics since construction
+    uint64_t GetReportCount() const { return reportCount; }
+    uint64_t GetInjectionCount() const { return injectionCount; }
+    uint64_t GetRotationEventCount() const { return rotationEventCount; }
+    int64_t GetSubmittedSteps() const { return submittedSteps; }
+    int64_t GetInjectedSteps() const { return injectedSteps; }
+
+    // Most recent report arrival to injection delays, in 100ns units
+    const std::vector<int64_t>& GetLatencies() const { return latencies; }
+
+private:
+    void RecordLatency(int64_t arrival, int64_t sent);
+
+    Clock clock;
+    InjectRotation inject;
+
+    int64_t period = 0;
+    int64_t lastFlush = 0;
+    bool armed = false;     // A deadline is scheduled
+
+    // Net rotation steps waiting for the next flush, per profile
+    std::vector<int> pending;
+
+    // Arrival times of the reports folded into pending
+    std::vector<int64_t> pendingArrivals;
+
+    static constexpr size_t MaxLatencySamples = 65536;
+    std::vector<int64_t> latencies;
+    size_t latencyCount = 0;
+
+    uint64_t reportCount = 0;
+    uint64_t injectionCount = 0;     // SendInput calls
+    uint64_t rotationEventCount = 0; // Input events inserted by rotation injections
+    int64_t submittedSteps = 0;
+    int64_t injectedSteps = 0;
+};
@@ -1,5 +1,9 @@
 #include "PowermateManager.h"
 #include "TriggerAction.h"
+#include "FlightRecorder.h"
+#include "OutputPacer.h"
+#include "LowLatency.h"
+#include "ReportDecoder.h"
 #include <hidsdi.h>
 #include <setupapi.h>
 #include <iostream>
@@ -14,6 +18,7 @@ std::atomic<bool> PowermateManager::running(false);
 std::atomic<bool> PowermateManager::connected(false);
 std::atomic<HANDLE> PowermateManager::hDevice{ INVALID_HANDLE_VALUE };
 std::thread PowermateManager::inputThread;
+HANDLE PowermateManager::hStopEvent = nullptr;
 std::mutex PowermateManager::deviceMutex;
 
 // Find Powermate device Path
@@ -61,7 +66,7 @@ bool PowermateManager::FindAndOpenDevice() {
 
     HANDLE h = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE,
                            FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
-                           OPEN_EXISTING, 0, nullptr);
+                           OPEN_EXISTING, FILE_FLAG_OVERLAPPED, nullptr);
 
     if (h == INVALID_HANDLE_VALUE) {
         std::cerr << "[Debug] Failed to open Powermate\n";
@@ -74,6 +79,7 @@ bool PowermateManager::FindAndOpenDevice() {
         connected.store(true);
     }
 
+    FlightRecorder::RecordState(STATE_CONNECTED);
     std::cerr << "[Debug] Powermate device connected\n";
 
     return true;
@@ -86,6 +92,18 @@ void PowermateManager::StartReading() {
     if (running.load()) return;
     if (!IsConnected()) return;
 
+    // Reap a loop that exited on its own after the device was unplugged
+    if (inputThread.joinable()) {
+        inputThread.join();
+    }
+
+    // Manual-reset so a stop requested before the first wait is not missed
+    if (!hStopEvent) {
+        hStopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        if (!hStopEvent) return;
+    }
+    ResetEvent(hStopEvent);
+
     running.store(true);
     inputThread = std::thread(&PowermateManager::InputLoop);
 }
@@ -94,24 +112,32 @@ void PowermateManager::StartReading() {
 void PowermateManager::HandleDeviceChange(WPARAM wParam) {
     std::wstring path;
 
-    if (wParam == DBT_DEVICEARRIVAL && FindAndOpenDevice()) {
-        StartReading();
+    if (wParam == DBT_DEVICEARRIVAL) {
+        // Another HID device arrived, keep the open handle
+        if (IsConnected()) return;
+        if (FindAndOpenDevice()) {
+            StartReading();
+        }
         return;
     } else if (wParam == DBT_DEVICEREMOVECOMPLETE) {
         if (FindPowerMateDevicePath(path)) {
             std::wcerr << L"[Debug] Powermate is still connected\n";
         } else {
             std::wcerr << L"[Debug] Powermate is no longer connected\n";
+            FlightRecorder::RecordState(STATE_DISCONNECTED);
             Stop();
         }
     } else if (wParam == PBT_APMSUSPEND) {
     std::wcout << L"[Debug] Suspending, stopping device\n";
+    FlightRecorder::RecordState(STATE_SUSPEND);
     Stop();
     }
     else if (wParam == PBT_APMRESUMESUSPEND) {
+        FlightRecorder::RecordState(STATE_RESUME);
         if (!IsConnected()) {
             if (FindAndOpenDevice()) {
                 std::wcout << L"[Debug] Reconnected after system resume\n";
+                StartReading();
             } else {
                 connected.store(false);
                 std::wcerr << L"[Debug] Failed to reconnect Powermate after resume\n";
@@ -124,36 +150,34 @@ void PowermateManager::HandleDeviceChange(WPARAM wParam) {
 void PowermateManager::InputLoop() {
     unsigned char buffer[8] = {};
     DWORD bytesRead = 0;
-    bool buttonDown = false;
-    int backoffMs = 1000;
-
-    while (running.load()) {
-        if (!IsConnected()) {
-            if (FindAndOpenDevice()) {
-                std::cout << "[Info] Device reconnected\n";
-                backoffMs = 1000;
-            } else {
-                std::cerr << "[Debug] Waiting for device...\n";
-                Sleep(backoffMs);
-                backoffMs = (backoffMs * 2 < 10000) ? backoffMs * 2 : 10000;
-                continue;
-            }
-        }
+    DWORD err = 0;
+    ReportDecoder decoder;
+    PowermateReport report;
+    HANDLE readEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    HANDLE mmcssTask = LowLatency::ApplyToCurrentThread();
+    if (!readEvent) {
+        std::cerr << "[Error] Failed to create read event\n";
+    }
 
+    // Reconnection is driven by device arrival notifications, never by polling
+    while (running.load() && readEvent) {
         HANDLE h;
         {
             std::lock_guard<std::mutex> lock(deviceMutex);
             h = hDevice.load();
         }
 
-        if (h == INVALID_HANDLE_VALUE) {
-            Sleep(1000);
-            continue;
+        if (h == INVALID_HANDLE_VALUE || !connected.load()) {
+            break;
         }
 
-        if (!ReadFile(h, buffer, sizeof(buffer), &bytesRead, nullptr)) {
-            DWORD err = GetLastError();
+        if (!ReadReport(h, readEvent, buffer, sizeof(buffer), bytesRead, err)) {
+            if (err == ERROR_OPERATION_ABORTED && !running.load()) {
+                break; // Stop requested, Stop() closes the device
+            }
+
             std::cerr << "[Error] ReadFile failed: " << err << "\n";
+            FlightRecorder::RecordState(STATE_READ_ERROR, err);
 
             if (err == ERROR_DEVICE_NOT_CONNECTED || err == ERROR_INVALID_HANDLE) {
                 connected.store(false);
@@ -178,42 +202,84 @@ void PowermateManager::InputLoop() {
             break;
         }
 
-        if (bytesRead < 3) continue;
+        int64_t arrival = OutputPacer::Now();
+        FlightRecorder::RecordReport(buffer, bytesRead);
+        if (!decoder.Decode(buffer, bytesRead, report)) continue;
 
-        int8_t rotation = static_cast<int8_t>(buffer[2]);
-        if (rotation != 0) {
-            std::cout << (rotation < 0 ? "ROTATE RIGHT" : "ROTATE LEFT") << std::endl;
-            HandleInput(rotation < 0 ? PowermateInputType::ROTATE_RIGHT : PowermateInputType::ROTATE_LEFT);
+        if (report.rotation != 0) {
+            std::cout << (report.rotation < 0 ? "ROTATE RIGHT " : "ROTATE LEFT ") << report.rotation << std::endl;
+            HandleRotation(report.rotation, arrival);
         }
 
-        bool isPressed = buffer[1] == 1;
-        if (isPressed != buttonDown) {
-            std::cout << (isPressed ? "BUTTON PRESSED" : "BUTTON RELEASED") << "\n";
-            buttonDown = isPressed;
-            if (!isPressed) {
-                HandleInput(PowermateInputType::BUTTON_RELEASE);
-            }
+        if (report.pressed) {
+            std::cout << "BUTTON PRESSED\n";
+        } else if (report.released) {
+            std::cout << "BUTTON RELEASED\n";
+            HandleInput(PowermateInputType::BUTTON_RELEASE, arrival);
         }
     }
 
+    LowLatency::RevertCurrentThread(mmcssTask);
+    if (readEvent) CloseHandle(readEvent);
     running.store(false);
 }
 
+// Read one report, sleeping until it arrives or Stop() is called
+bool PowermateManager::ReadReport(HANDLE h, HANDLE readEvent, unsigned char* buffer, DWORD size,
+                                  DWORD& bytesRead, DWORD& error) {
+    OVERLAPPED ov = {};
+    ov.hEvent = readEvent;
+    ResetEvent(readEvent);
 
-// Forward input to TriggerAction handler
-void PowermateManager::HandleInput(PowermateInputType inputType) {
-    TriggerAction::HandleAction(inputType);
+    if (!ReadFile(h, buffer, size, nullptr, &ov) && GetLastError() != ERROR_IO_PENDING) {
+        error = GetLastError();
+        return false;
+    }
+
+    HANDLE waits[2] = { hStopEvent, readEvent };
+    if (WaitForMultipleObjects(2, waits, FALSE, INFINITE) == WAIT_OBJECT_0) {
+        CancelIoEx(h, &ov);
+        GetOverlappedResult(h, &ov, &bytesRead, TRUE); // Wait for the cancellation
+        error = ERROR_OPERATION_ABORTED;
+        return false;
+    }
+
+    if (!GetOverlappedResult(h, &ov, &bytesRead, FALSE)) {
+        error = GetLastError();
+        return false;
+    }
+    return true;
+}
+
+
+// Forward input to TriggerAction handler, coalescing rotation
+void PowermateManager::HandleInput(PowermateInputType inputType, int64_t arrival) {
+    OutputPacer::Submit(inputType, arrival);
+}
+
+// Forward rotation steps, keeping the full count of the report
+void PowermateManager::HandleRotation(int steps, int64_t arrival) {
+    OutputPacer::SubmitRotation(steps, arrival);
+}
+
+// Native handle of the input thread
+HANDLE PowermateManager::GetInputThreadHandle() {
+    return running.load() && inputThread.joinable() ? inputThread.native_handle() : nullptr;
 }
 
 // Stop reading inputs and close device
 void PowermateManager::Stop() {
     running.store(false);
+    if (hStopEvent) {
+        SetEvent(hStopEvent); // Wake the loop out of its pending read
+    }
 
     if (inputThread.joinable()) {
         inputThread.join();
     }
 
     CloseDevice();
+    FlightRecorder::RecordState(STATE_STOPPED);
 }
 
 // Close device handle and mark as invalid
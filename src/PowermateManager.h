@@ -3,6 +3,7 @@
 #include "TriggerAction.h"
 #include <Windows.h>
 #include <atomic>
+#include <cstdint>
 #include <thread>
 #include <mutex>
 #include <string>
@@ -27,13 +28,23 @@ public:
     // Handle device change events (plug/unplug/suspend/resume)
     static void HandleDeviceChange(WPARAM wParam);
 
-    // Forward input events to the TriggerAction handler
-    static void HandleInput(PowermateInputType inputType);
+    // Forward input events to the TriggerAction handler through the output pacer
+    static void HandleInput(PowermateInputType inputType, int64_t arrival);
+
+    // Forward rotation steps decoded from one report through the output pacer
+    static void HandleRotation(int steps, int64_t arrival);
+
+    // Native handle of the input thread while it runs, for benchmarks
+    static HANDLE GetInputThreadHandle();
 
 private:
     // The main loop reading input reports from device
     static void InputLoop();
 
+    // Read one report with overlapped I/O, returns false on error or stop request
+    static bool ReadReport(HANDLE h, HANDLE readEvent, unsigned char* buffer, DWORD size,
+                           DWORD& bytesRead, DWORD& error);
+
     // Close the device handle safely
     static void CloseDevice();
 
@@ -44,5 +55,8 @@ private:
 
     // Input thread and synchronization mutex
     static std::thread inputThread;
+
+    // Signaled by Stop() to cancel the pending read
+    static HANDLE hStopEvent;
     static std::mutex deviceMutex;
 };
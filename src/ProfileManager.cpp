@@ -1,4 +1,5 @@
 #include "ProfileManager.h"
+#include "FlightRecorder.h"
 #include <iostream>
 
 // Initialize static variable
@@ -26,6 +27,7 @@ std::wstring ProfileManager::GetCurrentProfileName() {
 void ProfileManager::SetCurrentProfile(int index) {
     if (index >= 0 && index < GetProfileList().size()) {
         currentProfileIndex = index;
+        FlightRecorder::RecordProfile(index);
         std::wcout << L"[Debug] Current Profile set to: " << GetProfileList()[index] << std::endl;
     } else {
         std::wcout << L"[Error] Invalid profile index" << std::endl;
@@ -0,0 +1,18 @@
+#include "ReportDecoder.h"
+
+// Report layout: [0] report id, [1] button state, [2] signed rotation count
+bool ReportDecoder::Decode(const unsigned char* data, size_t size, PowermateReport& out) {
+    out = PowermateReport();
+    if (size < 3) return false;
+
+    // Keep the full count: fast spins report several steps at once
+    out.rotation = static_cast<int8_t>(data[2]);
+
+    bool isPressed = data[1] == 1;
+    if (isPressed != buttonDown) {
+        buttonDown = isPressed;
+        out.pressed = isPressed;
+        out.released = !isPressed;
+    }
+    return true;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Events decoded from a single PowerMate HID report
+struct PowermateReport {
+    int rotation = 0;       // Signed rotation count, positive is ROTATE_LEFT
+    bool pressed = false;   // Button went down in this report
+    bool released = false;  // Button went up in this report
+};
+
+// Decodes raw PowerMate reports, tracking the button state between them.
+// Kept free of platform headers so it can be driven by synthetic report streams.
+class ReportDecoder {
+public:
+    // Decode one report, returns false if it is too short to hold rotation and button
+    bool Decode(const unsigned char* data, size_t size, PowermateReport& out);
+
+private:
+    bool buttonDown = false;
+};
@@ -1,6 +1,7 @@
 #include "TriggerAction.h"
 #include "ProfileManager.h"
 #include <iostream>
+#include <vector>
 
 namespace {
 
@@ -19,6 +20,23 @@ void SendKey(WORD key, bool extended = false) {
     SendInput(2, input, sizeof(INPUT));
 }
 
+// Helper to simulate the same key pressed several times in one injection,
+// returns the number of events inserted
+UINT SendKeyRepeated(WORD key, int count) {
+    std::vector<INPUT> input(count * 2);
+
+    for (int i = 0; i < count; ++i) {
+        input[i * 2].type = INPUT_KEYBOARD;
+        input[i * 2].ki.wVk = key;
+
+        input[i * 2 + 1].type = INPUT_KEYBOARD;
+        input[i * 2 + 1].ki.wVk = key;
+        input[i * 2 + 1].ki.dwFlags = KEYEVENTF_KEYUP;
+    }
+
+    return SendInput(static_cast<UINT>(input.size()), input.data(), sizeof(INPUT));
+}
+
 // Helper to simulate mouse double click
 void SendMouseDoubleClick() {
     INPUT input[4] = {};
@@ -39,17 +57,21 @@ void ChangeVolume(bool increase) {
     SendKey(increase ? VK_VOLUME_UP : VK_VOLUME_DOWN);
 }
 
+UINT ChangeVolumeBy(int steps) {
+    return SendKeyRepeated(steps > 0 ? VK_VOLUME_UP : VK_VOLUME_DOWN, steps > 0 ? steps : -steps);
+}
+
 void ToggleMute() {
     SendKey(VK_VOLUME_MUTE);
 }
 
 // Helpers for scroll
-void ScrollMouse(int amount) {
+UINT ScrollMouse(int amount) {
     INPUT input = {};
     input.type = INPUT_MOUSE;
     input.mi.dwFlags = MOUSEEVENTF_WHEEL;
     input.mi.mouseData = amount;
-    SendInput(1, &input, sizeof(INPUT));
+    return SendInput(1, &input, sizeof(INPUT));
 }
 
 }  // namespace
@@ -93,3 +115,16 @@ void TriggerAction::HandleAction(PowermateInputType inputType) {
         }
     }
 }
+
+// Handle accumulated rotation steps based on profile
+unsigned int TriggerAction::HandleRotation(size_t profileIndex, int steps) {
+    if (steps == 0) return 0;
+
+    if (profileIndex == 0) { // Scroll profile
+        return ScrollMouse(-steps * WHEEL_DELTA);  // Left steps scroll left, right steps scroll right
+    }
+    else if (profileIndex == 1) { // Volume profile
+        return ChangeVolumeBy(steps);  // Left steps increase, right steps decrease
+    }
+    return 0;
+}
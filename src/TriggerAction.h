@@ -13,4 +13,10 @@ class TriggerAction {
 public:
     // Handles actions based on the input type (like rotation or button press)
     static void HandleAction(PowermateInputType inputType);
+
+    // Handles several rotation steps for a given profile with a single injection
+    // (positive steps are ROTATE_LEFT, negative steps are ROTATE_RIGHT).
+    // Returns the number of input events inserted: Scroll sends one wheel event
+    // for any step count, Volume sends a key down and up per step.
+    static unsigned int HandleRotation(size_t profileIndex, int steps);
 };
\ No newline at end of file
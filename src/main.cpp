@@ -1,4 +1,8 @@
 #include "PowermateManager.h"
+#include "FlightRecorder.h"
+#include "OutputPacer.h"
+#include "LowLatency.h"
+#include "Benchmark.h"
 #include "trayIcon.h"
 #include <windows.h>
 #include <iostream>
@@ -13,9 +17,78 @@ void InitConsole() {
     }
 }
 
+// Print to the console the benchmark was started from, or to a new one
+void InitBenchConsole() {
+    if (AttachConsole(ATTACH_PARENT_PROCESS) || AllocConsole()) {
+        freopen("CONOUT$", "w", stdout);
+        freopen("CONOUT$", "w", stderr);
+    }
+}
+
+// Expected device state from "-idlebench [absent|present]", nullptr for either
+const wchar_t* GetIdleBenchState(const wchar_t* arg) {
+    if (wcsstr(arg, L"absent") != nullptr) return L"absent";
+    if (wcsstr(arg, L"present") != nullptr) return L"present";
+    return nullptr;
+}
+
+// Decode a flight recorder dump given as "-decode <file>" into "<file>.txt"
+int DecodeFlightRecorder() {
+    int argc = 0;
+    LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+    if (!argv) return -1;
+
+    int result = -1;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (wcscmp(argv[i], L"-decode") == 0) {
+            std::wstring dumpPath = argv[i + 1];
+            result = FlightRecorder::Decode(dumpPath, dumpPath + L".txt") ? 0 : -1;
+            break;
+        }
+    }
+
+    LocalFree(argv);
+    return result;
+}
+
+// Pacing rate from "-pace <hz>", display refresh rate by default
+unsigned int GetPaceRate(PWSTR cmdLine) {
+    const wchar_t* arg = wcsstr(cmdLine, L"-pace ");
+    if (arg == nullptr) {
+        return OutputPacer::GetDisplayRefreshRate();
+    }
+    int rate = _wtoi(arg + wcslen(L"-pace "));
+    return rate > 0 ? static_cast<unsigned int>(rate) : 0;
+}
+
+// Low-latency options from "-lowlatency", "-affinity <mask>" and "-lockmem"
+void ConfigureLowLatency(PWSTR cmdLine) {
+    bool enabled = wcsstr(cmdLine, L"-lowlatency") != nullptr;
+    bool lockMemory = wcsstr(cmdLine, L"-lockmem") != nullptr;
+
+    DWORD_PTR affinityMask = 0;
+    const wchar_t* arg = wcsstr(cmdLine, L"-affinity ");
+    if (arg != nullptr) {
+        affinityMask = static_cast<DWORD_PTR>(wcstoull(arg + wcslen(L"-affinity "), nullptr, 0));
+    }
+
+    LowLatency::Configure(enabled, affinityMask, lockMemory);
+}
+
 // Entry point
 int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, PWSTR cmdLine, int) {
 
+    // Decoder mode, runs alongside the tray application
+    if (wcsstr(cmdLine, L"-decode") != nullptr) {
+        return DecodeFlightRecorder();
+    }
+
+    // Jitter benchmark, does not touch the device
+    if (wcsstr(cmdLine, L"-jitterbench") != nullptr) {
+        InitBenchConsole();
+        return Benchmark::RunJitter();
+    }
+
     HANDLE hMutex = CreateMutex(NULL, TRUE, L"UniqueAppMutexName");
 
          // Exit if the app is already running
@@ -29,11 +102,18 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, PWSTR cmdLine, int) {
             return 0;
         }
 
-    // Check if -debug
-    if (wcsstr(cmdLine, L"-debug") != nullptr) {
+    // Check if -debug or -idlebench
+    const wchar_t* idleBench = wcsstr(cmdLine, L"-idlebench");
+    if (idleBench != nullptr) {
+        InitBenchConsole();
+    } else if (wcsstr(cmdLine, L"-debug") != nullptr) {
         InitConsole();
     }
 
+    ConfigureLowLatency(cmdLine);
+    FlightRecorder::Open();
+    OutputPacer::Start(GetPaceRate(cmdLine));
+
     HWND hwnd = trayIcon.CreateTrayWindow(hInstance);  // Create tray window
     if (!hwnd) {
         std::cerr << "[Error] Failed to create tray window\n";
@@ -49,12 +129,21 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, PWSTR cmdLine, int) {
     SetWindowLongPtr(hwnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(&trayIcon));
 
     MSG msg = {};
-    while (GetMessage(&msg, nullptr, 0, 0) > 0) {
-        TranslateMessage(&msg);
-        DispatchMessage(&msg);
+    int result = 0;
+    if (idleBench != nullptr) {
+        // Benchmark the fully started application instead of waiting for Exit
+        result = Benchmark::RunIdle(GetIdleBenchState(idleBench));
+    } else {
+        while (GetMessage(&msg, nullptr, 0, 0) > 0) {
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+        result = static_cast<int>(msg.wParam);
     }
     PowermateManager::Stop();
+    OutputPacer::Stop();
+    FlightRecorder::Close();
 
     CloseHandle(hMutex);
-    return static_cast<int>(msg.wParam);
+    return result;
 }
\ No newline at end of file
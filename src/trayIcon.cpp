@@ -1,6 +1,7 @@
 #include "trayIcon.h"
 #include "PowermateManager.h"
 #include "ProfileManager.h"
+#include "FlightRecorder.h"
 #include "resource.h"
 #include <tchar.h>
 #include <windows.h>
@@ -106,6 +107,10 @@ void TrayIcon::PopulateTrayMenu() {
     }
     AppendMenu(hMenu, MF_SEPARATOR, 0, NULL);
 
+    // Add flight recorder dump
+    AppendMenuW(hMenu, MF_STRING, ID_TRAY_DIAGNOSTICS, L"Save diagnostics");
+    AppendMenu(hMenu, MF_SEPARATOR, 0, NULL);
+
     // Add Exit
     AppendMenu(hMenu, MF_STRING, ID_TRAY_EXIT, L"Exit");
 }
@@ -164,9 +169,25 @@ void TrayIcon::HandleTrayMenuSelection(WPARAM wParam) {
     } else if (id == ID_TRAY_AUTOSTART) {
         ToggleAutoStart();
         CheckMenuItem(hMenu, ID_TRAY_AUTOSTART, IsAutoStartEnabled() ? MF_CHECKED : MF_UNCHECKED);
+    } else if (id == ID_TRAY_DIAGNOSTICS) {
+        SaveDiagnostics();
     }
 }
 
+// Dump the flight recorder, decode it and show the timeline
+void TrayIcon::SaveDiagnostics() {
+    std::wstring dumpPath = FlightRecorder::GetDumpPath();
+    std::wstring textPath = dumpPath + L".txt";
+
+    if (!FlightRecorder::Dump(dumpPath) || !FlightRecorder::Decode(dumpPath, textPath)) {
+        std::wcerr << L"[Error] Failed to save diagnostics\n";
+        return;
+    }
+
+    std::wcout << L"[Debug] Diagnostics saved to: " << textPath << std::endl;
+    ShellExecuteW(nullptr, L"open", textPath.c_str(), nullptr, nullptr, SW_SHOWNORMAL);
+}
+
 // Run at Startup
 bool TrayIcon::IsAutoStartEnabled() {
     const wchar_t* appName = L"PowerMateControl";
@@ -23,6 +23,7 @@ private:
 public:
     static constexpr UINT ID_TRAY_EXIT = 10000;
     static constexpr UINT ID_TRAY_AUTOSTART = 4001;
+    static constexpr UINT ID_TRAY_DIAGNOSTICS = 4002;
     static constexpr const wchar_t* runKey = L"Software\\Microsoft\\Windows\\CurrentVersion\\Run";
     static constexpr const wchar_t* approvedKey = L"Software\\Microsoft\\Windows\\CurrentVersion\\Explorer\\StartupApproved\\Run";
     static constexpr UINT ID_TRAY_PROFILE_BASE = 100;
@@ -38,4 +39,5 @@ public:
     static void ToggleAutoStart();
     static bool IsAutoStartEnabled();
     static bool WasDisabledByWindows();
+    static void SaveDiagnostics();
 };
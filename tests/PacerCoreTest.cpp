@@ -0,0 +1,328 @@
+// Drives PacerCore with a scripted clock and checks that every submitted
+// rotation step is injected, in order with button events. Also compares
+// paced and pass-through output on a reproducible 1 kHz rotation stream.
+//
+// g++ -std=c++17 -Wall -Wextra -O2 -Isrc tests/PacerCoreTest.cpp src/PacerCore.cpp -o PacerCoreTest
+
+#include "PacerCore.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            std::printf("[FAIL] %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+            ++failures;                                                     \
+        }                                                                   \
+    } while (0)
+
+const int64_t Period = 100000; // 100 Hz in 100ns units
+
+// One injection as seen by the fake output, profile -1 is a button
+struct Injection {
+    int profile;
+    int steps;
+};
+
+// Events TriggerAction::HandleRotation inserts: one wheel event for Scroll,
+// a key down and up per step for Volume
+unsigned int EventsFor(size_t profile, int steps) {
+    if (profile == 0) return 1;
+    if (profile == 1) return 2u * static_cast<unsigned int>(steps < 0 ? -steps : steps);
+    return 0;
+}
+
+// Pacer wired to a fake clock and a recording output.
+// Each injection advances the clock by injectCost, standing in for SendInput.
+struct Harness {
+    int64_t now = 1000000;
+    int64_t injectCost = 0;
+    std::vector<Injection> log;
+    PacerCore core;
+
+    Harness()
+        : core([this] { return now; },
+               [this](size_t profile, int steps) {
+                   log.push_back({ static_cast<int>(profile), steps });
+                   now += injectCost;
+                   return EventsFor(profile, steps);
+               }) {}
+
+    void Button() {
+        core.SubmitButton(now, [this] { log.push_back({ -1, 0 }); });
+    }
+
+    long long Injected(int profile) const {
+        long long total = 0;
+        for (const Injection& i : log) {
+            if (i.profile == profile) total += i.steps;
+        }
+        return total;
+    }
+};
+
+void TestLeadingEdgeAndCoalescing() {
+    Harness h;
+    h.core.SetPeriod(Period);
+
+    // First report after idle goes out at once
+    CHECK(h.core.SubmitRotation(0, 2, h.now) == 0);
+    CHECK(h.log.size() == 1 && h.log[0].steps == 2);
+
+    // Reports inside the period are folded into one deadline
+    h.now += 10000;
+    CHECK(h.core.SubmitRotation(0, 3, h.now) == Period - 10000);
+    h.now += 10000;
+    CHECK(h.core.SubmitRotation(0, -1, h.now) == 0);
+    CHECK(h.log.size() == 1);
+
+    h.now += Period - 20000;
+    h.core.OnDeadline();
+    CHECK(h.log.size() == 2 && h.log[1].steps == 2);
+    CHECK(h.core.GetInjectedSteps() == h.core.GetSubmittedSteps());
+    CHECK(h.core.GetRotationEventCount() == 2);
+    CHECK(h.core.GetLatencies().size() == 3);
+    CHECK(h.core.GetLatencies()[1] == Period - 10000);
+}
+
+void TestInterleavedButtons() {
+    Harness h;
+    h.core.SetPeriod(Period);
+    h.core.SubmitRotation(0, 1, h.now);
+    h.now += 1000;
+    CHECK(h.core.SubmitRotation(0, 4, h.now) != 0);
+
+    // Pending rotation is sent before the button, the stale deadline then does nothing
+    h.now += 1000;
+    h.Button();
+    CHECK(!h.core.IsArmed());
+    h.now += Period;
+    h.core.OnDeadline();
+    CHECK(h.log.size() == 3);
+    CHECK(h.log[1].profile == 0 && h.log[1].steps == 4);
+    CHECK(h.log[2].profile == -1);
+    CHECK(h.core.GetReportCount() == 3);
+    CHECK(h.core.GetInjectedSteps() == h.core.GetSubmittedSteps());
+}
+
+void TestProfileSwitch() {
+    Harness h;
+    h.core.SetPeriod(Period);
+    h.core.SubmitRotation(0, 1, h.now);
+
+    // Switching profiles while rotation is pending keeps both totals,
+    // including profiles added after the pacer started
+    h.now += 1000;
+    h.core.SubmitRotation(0, 3, h.now);
+    h.core.SubmitRotation(1, -2, h.now);
+    h.core.SubmitRotation(7, 5, h.now);
+    h.now += Period;
+    h.core.OnDeadline();
+    CHECK(h.Injected(0) == 4);
+    CHECK(h.Injected(1) == -2);
+    CHECK(h.Injected(7) == 5);
+    CHECK(h.core.GetInjectedSteps() == h.core.GetSubmittedSteps());
+
+    // A Volume flush of N steps is one injection but 2N events
+    CHECK(h.core.GetInjectionCount() == 4);
+    CHECK(h.core.GetRotationEventCount() == 1 + 1 + 4);
+}
+
+void TestStopFlushes() {
+    Harness h;
+    h.core.SetPeriod(Period);
+    h.core.SubmitRotation(0, 1, h.now);
+    h.core.SubmitRotation(0, 6, h.now);
+    h.core.SubmitRotation(2, -3, h.now);
+
+    // OutputPacer::Stop() disables the core before the timer is closed
+    h.core.Disable();
+    CHECK(h.core.GetPeriod() == 0);
+    CHECK(h.Injected(0) == 7 && h.Injected(2) == -3);
+    CHECK(h.core.GetInjectedSteps() == h.core.GetSubmittedSteps());
+}
+
+void TestTimerFailureFallback() {
+    Harness h;
+    h.core.SetPeriod(Period);
+    h.core.SubmitRotation(0, 1, h.now);
+
+    // SetWaitableTimer failed: OutputPacer flushes right away
+    CHECK(h.core.SubmitRotation(0, 2, h.now) != 0);
+    h.core.OnDeadline();
+    CHECK(h.Injected(0) == 3);
+
+    // Timer wait failed: pending rotation is sent, then every report passes through
+    CHECK(h.core.SubmitRotation(0, 4, h.now) != 0);
+    h.core.Disable();
+    CHECK(h.Injected(0) == 7);
+    size_t before = h.log.size();
+    CHECK(h.core.SubmitRotation(0, -1, h.now) == 0);
+    CHECK(h.log.size() == before + 1 && h.log.back().steps == -1);
+    CHECK(h.core.GetInjectedSteps() == h.core.GetSubmittedSteps());
+}
+
+// Sustained stream: pseudo-random rotation, buttons, profile switches and
+// a timer failure, with the deadline serviced as the flush thread would
+void BenchSustainedStream() {
+    const size_t count = 2000000;
+    const int profiles = 4;
+
+    Harness h;
+    h.core.SetPeriod(Period);
+
+    std::vector<long long> submitted(profiles, 0);
+    long long magnitude = 0;
+    int64_t deadline = 0;
+    int profile = 0;
+    uint32_t seed = 12345;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        h.now += 5000 + (seed >> 20) % 10000; // 0.5 to 1.5 ms between reports
+        if (h.core.IsArmed() && h.now >= deadline) {
+            h.core.OnDeadline();
+        }
+        if (i == count / 2) {
+            h.core.Disable(); // Timer failure halfway through
+        }
+
+        if (((seed >> 4) & 0xFF) == 0) {
+            profile = (seed >> 12) % profiles;
+        }
+        if (((seed >> 4) & 0x3F) == 1) {
+            h.Button();
+            continue;
+        }
+
+        int steps = static_cast<int>((seed >> 8) % 15) - 7;
+        if (steps == 0) continue;
+        submitted[profile] += steps;
+        magnitude += steps < 0 ? -steps : steps;
+        int64_t delay = h.core.SubmitRotation(profile, steps, h.now);
+        if (delay) deadline = h.now + delay;
+    }
+    h.core.Disable();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    long long lost = 0;
+    for (int p = 0; p < profiles; ++p) {
+        long long diff = submitted[p] - h.Injected(p);
+        CHECK(diff == 0);
+        lost += diff < 0 ? -diff : diff;
+    }
+    CHECK(h.core.GetInjectedSteps() == h.core.GetSubmittedSteps());
+
+    std::printf("[Bench] %zu reports in %.3f s: %.0f reports/s, %llu injections, drop rate %.6f%%\n",
+                count, seconds, count / seconds,
+                static_cast<unsigned long long>(h.core.GetInjectionCount()), 100.0 * lost / magnitude);
+}
+
+// Result of one scripted run
+struct RunStats {
+    uint64_t injections;
+    uint64_t events;
+    double p50, p90, p99, max; // Milliseconds
+};
+
+// Scripted 1 kHz rotation stream: 5 s on Scroll then 5 s on Volume, one step
+// per report with direction reversals, as a fast spin of the knob produces.
+// Deadlines fire exactly on time and every SendInput costs 20 us of clock.
+RunStats RunScripted(unsigned int rateHz) {
+    const int reports = 10000;
+    const int64_t interval = 10000; // 1 ms
+
+    Harness h;
+    h.injectCost = 200;
+    h.core.SetPeriod(rateHz ? 10000000 / rateHz : 0);
+
+    int64_t arrival = h.now;
+    int64_t deadline = 0;
+    long long submitted = 0;
+    for (int i = 0; i < reports; ++i) {
+        arrival += interval;
+
+        // The flush thread services deadlines that fall before this report
+        if (h.core.IsArmed() && deadline <= arrival) {
+            if (h.now < deadline) h.now = deadline;
+            h.core.OnDeadline();
+        }
+        if (h.now < arrival) h.now = arrival;
+
+        size_t profile = i < reports / 2 ? 0 : 1;
+        int steps = (i / 250) % 2 ? -1 : 1;
+        submitted += steps;
+        int64_t delay = h.core.SubmitRotation(profile, steps, h.now);
+        if (delay) deadline = h.now + delay;
+    }
+    if (h.core.IsArmed()) {
+        if (h.now < deadline) h.now = deadline;
+        h.core.OnDeadline();
+    }
+    h.core.Disable();
+
+    CHECK(h.core.GetSubmittedSteps() == submitted);
+    CHECK(h.core.GetInjectedSteps() == submitted);
+
+    std::vector<int64_t> sorted(h.core.GetLatencies());
+    std::sort(sorted.begin(), sorted.end());
+    auto at = [&](double p) { return sorted[static_cast<size_t>(p * (sorted.size() - 1))] / 10000.0; };
+    return RunStats{ h.core.GetInjectionCount(), h.core.GetRotationEventCount(),
+                     at(0.50), at(0.90), at(0.99), sorted.back() / 10000.0 };
+}
+
+// Paced against pass-through output on the same stream
+void BenchPacedVsPassThrough() {
+    const unsigned int rates[] = { 0, 60, 144, 240 };
+    std::printf("[Bench] 1 kHz rotation, 10000 reports\n");
+    std::printf("[Bench] %-12s %10s %10s %8s %8s %8s %8s\n", "mode", "injections", "events", "p50 ms", "p90 ms", "p99 ms", "max ms");
+
+    RunStats passThrough = {};
+    for (unsigned int rate : rates) {
+        RunStats stats = RunScripted(rate);
+        char mode[16];
+        if (rate) {
+            std::snprintf(mode, sizeof(mode), "%u Hz", rate);
+        } else {
+            std::snprintf(mode, sizeof(mode), "pass-through");
+            passThrough = stats;
+        }
+        std::printf("[Bench] %-12s %10llu %10llu %8.2f %8.2f %8.2f %8.2f\n", mode,
+                    static_cast<unsigned long long>(stats.injections), static_cast<unsigned long long>(stats.events),
+                    stats.p50, stats.p90, stats.p99, stats.max);
+
+        // Pacing must cut injections and stay within one period of the report
+        if (rate) {
+            CHECK(stats.injections < passThrough.injections);
+            CHECK(stats.max <= 1000.0 / rate + 1.0);
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    TestLeadingEdgeAndCoalescing();
+    TestInterleavedButtons();
+    TestProfileSwitch();
+    TestStopFlushes();
+    TestTimerFailureFallback();
+    BenchSustainedStream();
+    BenchPacedVsPassThrough();
+
+    if (failures) {
+        std::printf("%d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    std::printf("All PacerCore checks passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,152 @@
+// Replays scripted PowerMate report streams through ReportDecoder and
+// checks that no rotation count or button event is lost.
+//
+// g++ -std=c++17 -Wall -Wextra -O2 -Isrc tests/ReportDecoderTest.cpp src/ReportDecoder.cpp -o ReportDecoderTest
+
+#include "ReportDecoder.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            std::printf("[FAIL] %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+            ++failures;                                                     \
+        }                                                                   \
+    } while (0)
+
+// One raw report as the device sends it: [0] report id, [1] button, [2] rotation
+struct Report {
+    std::vector<unsigned char> bytes;
+};
+
+Report Make(int button, int rotation) {
+    return Report{ { 0x00, static_cast<unsigned char>(button), static_cast<unsigned char>(static_cast<int8_t>(rotation)), 0x00, 0x00, 0x00 } };
+}
+
+// Totals produced by a stream
+struct Totals {
+    long long rotation = 0;
+    int presses = 0;
+    int releases = 0;
+    int rejected = 0;
+};
+
+void Replay(ReportDecoder& decoder, const std::vector<Report>& stream, Totals& totals) {
+    PowermateReport out;
+    for (const Report& r : stream) {
+        if (!decoder.Decode(r.bytes.data(), r.bytes.size(), out)) {
+            ++totals.rejected;
+            continue;
+        }
+        totals.rotation += out.rotation;
+        totals.presses += out.pressed ? 1 : 0;
+        totals.releases += out.released ? 1 : 0;
+    }
+}
+
+void TestMultiCountRotation() {
+    ReportDecoder decoder;
+    Totals totals;
+    Replay(decoder, { Make(0, 1), Make(0, 2), Make(0, 5), Make(0, -3), Make(0, 0), Make(0, -7) }, totals);
+    CHECK(totals.rotation == -2);
+    CHECK(totals.presses == 0 && totals.releases == 0);
+}
+
+void TestExtremes() {
+    ReportDecoder decoder;
+    Totals totals;
+    Replay(decoder, { Make(0, 127) }, totals);
+    CHECK(totals.rotation == 127);
+
+    totals = Totals();
+    Replay(decoder, { Make(0, -127), Make(0, -128) }, totals);
+    CHECK(totals.rotation == -255);
+}
+
+void TestShortReports() {
+    ReportDecoder decoder;
+    Totals totals;
+    std::vector<Report> stream = { Report{ {} }, Report{ { 0x00 } }, Report{ { 0x00, 0x01 } }, Make(0, 4) };
+    Replay(decoder, stream, totals);
+    CHECK(totals.rejected == 3);
+    CHECK(totals.rotation == 4);
+    CHECK(totals.presses == 0); // A short report must not change the button state
+
+    // Exactly three bytes is the shortest usable report
+    PowermateReport out;
+    const unsigned char minimal[3] = { 0x00, 0x01, 0xFE };
+    CHECK(decoder.Decode(minimal, sizeof(minimal), out));
+    CHECK(out.rotation == -2 && out.pressed);
+}
+
+void TestPressRelease() {
+    ReportDecoder decoder;
+    Totals totals;
+    // Rotation while held, repeated pressed reports, then two clicks
+    Replay(decoder, { Make(1, 0), Make(1, 3), Make(1, 0), Make(0, 0), Make(0, 1), Make(1, 0), Make(0, -1) }, totals);
+    CHECK(totals.presses == 2);
+    CHECK(totals.releases == 2);
+    CHECK(totals.rotation == 3);
+}
+
+// Sustained stream: pseudo-random reports, expected totals computed independently
+void BenchSustainedStream() {
+    const size_t count = 5000000;
+    std::vector<Report> stream;
+    stream.reserve(count);
+
+    long long expectedRotation = 0;
+    int expectedPresses = 0;
+    int expectedReleases = 0;
+    int button = 0;
+    uint32_t seed = 12345;
+
+    for (size_t i = 0; i < count; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        int rotation = static_cast<int>((seed >> 8) % 256) - 128;
+        int nextButton = ((seed >> 4) & 0x1F) == 0 ? 1 - button : button;
+        if (nextButton != button) {
+            (nextButton ? expectedPresses : expectedReleases)++;
+        }
+        button = nextButton;
+        expectedRotation += rotation;
+        stream.push_back(Make(button, rotation));
+    }
+
+    ReportDecoder decoder;
+    Totals totals;
+    auto start = std::chrono::steady_clock::now();
+    Replay(decoder, stream, totals);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    CHECK(totals.rotation == expectedRotation);
+    CHECK(totals.presses == expectedPresses);
+    CHECK(totals.releases == expectedReleases);
+
+    std::printf("[Bench] %zu reports decoded in %.3f s: %.0f reports/s\n", count, seconds, count / seconds);
+}
+
+}  // namespace
+
+int main() {
+    TestMultiCountRotation();
+    TestExtremes();
+    TestShortReports();
+    TestPressRelease();
+    BenchSustainedStream();
+
+    if (failures) {
+        std::printf("%d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    std::printf("All ReportDecoder checks passed\n");
+    return EXIT_SUCCESS;
+}